@@ -26,6 +26,31 @@ $GCC -std=c++11 -Wall -Wextra -Wno-unused-parameter -DUNICODE -D_UNICODE \
      src/primary.cpp \
      resources/primary.res \
      -o Primary.exe \
-     -luser32 -lshell32 -static-libgcc -static-libstdc++
+     -luser32 -lshell32 -lgdi32 -static-libgcc -static-libstdc++
 
 echo "Build successful! Output: Primary.exe"
+
+# Optional benchmark tools: ./build.sh bench
+if [ "$1" = "bench" ]; then
+    echo "Compiling raw input flood benchmark..."
+    $GCC -std=c++11 -Wall -Wextra -Wno-unused-parameter -DUNICODE -D_UNICODE \
+         -municode \
+         tools/flood_bench.cpp \
+         -o FloodBench.exe \
+         -luser32 -static-libgcc -static-libstdc++
+
+    echo "Build successful! Output: FloodBench.exe"
+fi
+
+# Optional tray badge GDI self-check: ./build.sh selftest
+if [ "$1" = "selftest" ]; then
+    echo "Compiling tray badge self-check..."
+    $GCC -std=c++11 -Wall -Wextra -Wno-unused-parameter -DUNICODE -D_UNICODE \
+         -DPRIMARY_SELFTEST -municode \
+         src/primary.cpp \
+         resources/primary.res \
+         -o PrimarySelfTest.exe \
+         -luser32 -lshell32 -lgdi32 -static-libgcc -static-libstdc++
+
+    echo "Build successful! Output: PrimarySelfTest.exe"
+fi
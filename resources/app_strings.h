@@ -19,6 +19,7 @@
 // Registry keys and values
 #define APP_REGISTRY_VALUE              APP_NAME
 #define APP_SETTINGS_REGISTRY_KEY       L"Software\\" APP_NAME
+#define APP_DEVICE_OVERRIDES_REGISTRY_KEY APP_SETTINGS_REGISTRY_KEY L"\\DeviceOverrides"
 
 // UI Strings
 #define APP_TRAY_TOOLTIP                APP_NAME L" - Double-click either button to flip"
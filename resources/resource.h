@@ -18,6 +18,8 @@
 #define IDC_DETECTED_DEVICES_LABEL  2005
 #define IDC_BASE_DEVICES_EDIT       2006
 #define IDC_BASE_DEVICES_LABEL      2007
+#define IDC_FOLLOWACTIVE_CHECKBOX   2008
+#define IDC_ACTIVE_EXTERNAL_CHECKBOX 2009
 
 // Menu item IDs
 #define IDM_RIGHTHANDED             1001
@@ -31,5 +33,6 @@
 
 // Timer IDs
 #define TIMER_AUTOSWITCH            1
+#define TIMER_RAWINPUT_RESUME       2
 
 #endif // RESOURCE_H
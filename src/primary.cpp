@@ -2,6 +2,10 @@
 #define UNICODE
 #endif
 
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7+ for raw input device notifications
+#endif
+
 #include <windows.h>
 #include <shellapi.h>
 #include "../resources/resource.h"
@@ -14,10 +18,38 @@ const wchar_t* REGISTRY_VALUE = APP_REGISTRY_VALUE;
 const wchar_t* SETTINGS_REGISTRY_KEY = APP_SETTINGS_REGISTRY_KEY;
 const wchar_t* AUTOSWITCH_VALUE = L"AutoSwitch";
 const wchar_t* BASE_MOUSE_COUNT_VALUE = L"BaseMouseCount";
+const wchar_t* FOLLOW_ACTIVE_VALUE = L"FollowActiveDevice";
+const wchar_t* DEVICE_OVERRIDES_REGISTRY_KEY = APP_DEVICE_OVERRIDES_REGISTRY_KEY;
 NOTIFYICONDATA g_nid = {};
 HWND g_hwndMain = NULL;
 bool g_lastDisplayState = false;  // Track last external mouse connection state
 
+// Follow-active-device mode: after one raw mouse packet is sampled, background
+// input is switched off for a pause so a high-rate mouse is not dispatched at all.
+const UINT RAW_INPUT_PAUSE_MS = 100;
+const int DEVICE_CLASS_CACHE_SIZE = 16;  // Also the present-device table for the badge count
+struct DeviceClassEntry {
+    HANDLE hDevice;
+    bool isExternal;
+};
+bool g_followActiveDevice = false;  // Raw input (not the timer) drives auto-switch
+bool g_rawInputRegistered = false;  // Registered for device notifications
+bool g_rawInputSampling = false;    // Background input is delivered (not paused)
+HANDLE g_lastInputDevice = INVALID_HANDLE_VALUE;  // Device of the last sampled packet
+DeviceClassEntry g_deviceClassCache[DEVICE_CLASS_CACHE_SIZE] = {};
+
+// Tray badge: orientation icon plus auto-switch dot and external mouse count.
+// Every distinct state is rendered once and kept, so state changes cost no GDI work.
+// Counts are shown only while auto-switch is active: 0-9, then an overflow "+".
+const int TRAY_BADGE_MAX_COUNT = 9;
+const int TRAY_BADGE_COUNT_SLOTS = TRAY_BADGE_MAX_COUNT + 2;  // 0..9 and overflow
+const int TRAY_BADGE_CACHE_SIZE = 2 + 2 * TRAY_BADGE_COUNT_SLOTS;  // Inactive, then active
+HICON g_trayBadgeCache[TRAY_BADGE_CACHE_SIZE] = {};
+bool g_trayBadgeShared[TRAY_BADGE_CACHE_SIZE] = {};  // Slot holds the shared fallback icon
+int g_trayIconSize = 0;           // Pixel size the cached icons were rendered at
+bool g_autoSwitchActive = false;  // Auto-switch monitoring is running
+int g_externalMouseCount = 0;     // External mice currently shown on the badge
+
 // Forward declarations
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 INT_PTR CALLBACK OptionsDialogProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -27,6 +59,12 @@ void FlipMouseOrientation();
 UINT GetIconForCurrentState();
 void AddTrayIcon(HWND hwnd, UINT iconID);
 void UpdateTrayIcon(HWND hwnd, UINT iconID);
+HICON GetTrayBadgeIcon(UINT iconID);
+HICON RenderTrayBadge(UINT iconID, bool autoSwitchActive, int externalCount, int size);
+void ReleaseTrayBadgeCache();
+#ifdef PRIMARY_SELFTEST
+int RunTrayBadgeSelfTest();
+#endif
 void RemoveTrayIcon(HWND hwnd);
 void ShowContextMenu(HWND hwnd, POINT pt);
 void UpdateMenuChecks(HMENU hMenu);
@@ -39,13 +77,37 @@ bool SetAutoSwitchEnabled(bool enable);
 int GetCurrentMouseDeviceCount();
 int GetBaseMouseCount();
 bool SetBaseMouseCount(int count);
+int GetExternalMouseCount();
 bool IsExternalMouseConnected();
+bool IsFollowActiveDeviceEnabled();
+bool SetFollowActiveDeviceEnabled(bool enable);
+bool GetMouseDeviceName(HANDLE hDevice, wchar_t* name, UINT size);
+int GetMouseDeviceOverride(const wchar_t* name);
+bool SetMouseDeviceOverride(HANDLE hDevice, bool isExternal);
+bool ClassifyMouseDevice(HANDLE hDevice);
+bool AddMouseDevice(HANDLE hDevice);
+bool IsExternalMouseDevice(HANDLE hDevice);
+void ForgetMouseDevice(HANDLE hDevice);
+int CountExternalMouseDevices();
+void UpdateFollowedMouseCount();
+bool SetRawMouseSampling(HWND hwnd, bool sampling);
+bool RegisterRawMouseInput(HWND hwnd);
+void UnregisterRawMouseInput(HWND hwnd);
+void HandleRawMouseInput(HWND hwnd, HRAWINPUT hRawInput);
+void ApplyAutoSwitchState(bool externalMouseActive);
 void CheckAndApplyAutoSwitch();
 void StartAutoSwitchMonitoring(HWND hwnd);
 void StopAutoSwitchMonitoring(HWND hwnd);
 wchar_t* GetExecutablePath();
 
 // Entry point
+#ifdef PRIMARY_SELFTEST
+// Self-check builds are console programs, so the exit code can be scripted
+int wmain() {
+    return RunTrayBadgeSelfTest();
+}
+#endif
+
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow) {
     // Register window class
     WNDCLASSEX wc = {};
@@ -89,6 +151,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         DispatchMessage(&msg);
     }
 
+    ReleaseTrayBadgeCache();
     return (int)msg.wParam;
 }
 
@@ -110,7 +173,28 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_TIMER:
             if (wParam == TIMER_AUTOSWITCH) {
                 CheckAndApplyAutoSwitch();
+            } else if (wParam == TIMER_RAWINPUT_RESUME) {
+                // Pause over: take the next raw mouse packet
+                // If re-registration fails, keep the timer so the next tick retries
+                if (!g_followActiveDevice || SetRawMouseSampling(hwnd, true)) {
+                    KillTimer(hwnd, TIMER_RAWINPUT_RESUME);
+                }
+            }
+            return 0;
+
+        case WM_INPUT:
+            HandleRawMouseInput(hwnd, (HRAWINPUT)lParam);
+            break;  // DefWindowProc must still run to release the raw input buffer
+
+        case WM_INPUT_DEVICE_CHANGE:
+            if (wParam == GIDC_REMOVAL) {
+                // Handles can be reused by the next device that arrives
+                ForgetMouseDevice((HANDLE)lParam);
+            } else {
+                // Classify once on arrival; repeated arrivals hit the table
+                AddMouseDevice((HANDLE)lParam);
             }
+            UpdateFollowedMouseCount();
             return 0;
 
         case WM_TRAYICON:
@@ -197,7 +281,7 @@ void AddTrayIcon(HWND hwnd, UINT iconID) {
     g_nid.uID = 1;
     g_nid.uFlags = NIF_ICON | NIF_MESSAGE | NIF_TIP;
     g_nid.uCallbackMessage = WM_TRAYICON;
-    g_nid.hIcon = LoadIcon(GetModuleHandle(NULL), MAKEINTRESOURCE(iconID));
+    g_nid.hIcon = GetTrayBadgeIcon(iconID);
     wcsncpy(g_nid.szTip, APP_TRAY_TOOLTIP,
             sizeof(g_nid.szTip) / sizeof(wchar_t) - 1);
     g_nid.szTip[sizeof(g_nid.szTip) / sizeof(wchar_t) - 1] = L'\0';
@@ -207,10 +291,215 @@ void AddTrayIcon(HWND hwnd, UINT iconID) {
 
 // Update tray icon
 void UpdateTrayIcon(HWND hwnd, UINT iconID) {
-    g_nid.hIcon = LoadIcon(GetModuleHandle(NULL), MAKEINTRESOURCE(iconID));
+    g_nid.hIcon = GetTrayBadgeIcon(iconID);
     Shell_NotifyIcon(NIM_MODIFY, &g_nid);
 }
 
+// Get the tray icon for the given orientation and the current badge state
+// Rendered on first use; afterwards this is a single cache lookup.
+HICON GetTrayBadgeIcon(UINT iconID) {
+    int size = GetSystemMetrics(SM_CXSMICON);
+    if (size != g_trayIconSize) {
+        ReleaseTrayBadgeCache();
+        g_trayIconSize = size;
+    }
+
+    int hand = (iconID == IDI_ICON_LEFT) ? 1 : 0;
+    // The external count is only meaningful while auto-switch is watching devices
+    int externalCount = 0;
+    int index = hand;
+    if (g_autoSwitchActive) {
+        externalCount = g_externalMouseCount;
+        if (externalCount > TRAY_BADGE_MAX_COUNT) {
+            externalCount = TRAY_BADGE_MAX_COUNT + 1;  // Overflow slot
+        }
+        index = 2 + hand * TRAY_BADGE_COUNT_SLOTS + externalCount;
+    }
+    if (g_trayBadgeCache[index] == NULL) {
+        g_trayBadgeCache[index] = RenderTrayBadge(iconID, g_autoSwitchActive, externalCount, size);
+        if (g_trayBadgeCache[index] == NULL) {
+            // Rendering failed: keep the plain resource icon so this state is not re-rendered
+            g_trayBadgeCache[index] = LoadIcon(GetModuleHandle(NULL), MAKEINTRESOURCE(iconID));
+            g_trayBadgeShared[index] = true;
+        }
+    }
+
+    return g_trayBadgeCache[index];
+}
+
+// Compose a tray icon from the orientation icon and its badges
+// The resource icons are masked (no alpha), so badges are drawn into both the
+// color bitmap and the AND mask, where black marks opaque pixels.
+HICON RenderTrayBadge(UINT iconID, bool autoSwitchActive, int externalCount, int size) {
+    HINSTANCE hInstance = GetModuleHandle(NULL);
+    HICON hBase = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(iconID), IMAGE_ICON, size, size, LR_DEFAULTCOLOR);
+
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdcColor = CreateCompatibleDC(hdcScreen);
+    HDC hdcMask = CreateCompatibleDC(hdcScreen);
+    HBITMAP hColor = CreateCompatibleBitmap(hdcScreen, size, size);
+    HBITMAP hMask = CreateBitmap(size, size, 1, 1, NULL);
+    ReleaseDC(NULL, hdcScreen);
+
+    HICON hIcon = NULL;
+    if (hBase && hdcColor && hdcMask && hColor && hMask) {
+        HGDIOBJ hOldColor = SelectObject(hdcColor, hColor);
+        HGDIOBJ hOldMask = SelectObject(hdcMask, hMask);
+
+        DrawIconEx(hdcColor, 0, 0, hBase, size, size, 0, NULL, DI_IMAGE);
+        DrawIconEx(hdcMask, 0, 0, hBase, size, size, 0, NULL, DI_MASK);
+
+        SelectObject(hdcColor, GetStockObject(DC_BRUSH));
+        SelectObject(hdcColor, GetStockObject(NULL_PEN));
+        SelectObject(hdcMask, GetStockObject(BLACK_BRUSH));
+        SelectObject(hdcMask, GetStockObject(NULL_PEN));
+
+        // Auto-switch active: green dot, bottom-left
+        if (autoSwitchActive) {
+            int dot = size * 3 / 8;
+            SetDCBrushColor(hdcColor, RGB(0, 170, 0));
+            Ellipse(hdcColor, 0, size - dot, dot + 1, size + 1);
+            Ellipse(hdcMask, 0, size - dot, dot + 1, size + 1);
+        }
+
+        // External mice seen: count on a blue square, bottom-right ("+" above the maximum)
+        if (externalCount > 0) {
+            int badge = size * 9 / 16;
+            RECT rc = { size - badge, size - badge, size, size };
+            SetDCBrushColor(hdcColor, RGB(0, 90, 200));
+            FillRect(hdcColor, &rc, (HBRUSH)GetStockObject(DC_BRUSH));
+            FillRect(hdcMask, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
+
+            HFONT hFont = CreateFont(badge + 1, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                                     OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, NONANTIALIASED_QUALITY,
+                                     DEFAULT_PITCH | FF_SWISS, L"Segoe UI");
+            HGDIOBJ hOldFont = SelectObject(hdcColor, hFont);
+            wchar_t digit[2] = { (wchar_t)(L'0' + externalCount), L'\0' };
+            if (externalCount > TRAY_BADGE_MAX_COUNT) {
+                digit[0] = L'+';
+            }
+            SetBkMode(hdcColor, TRANSPARENT);
+            SetTextColor(hdcColor, RGB(255, 255, 255));
+            DrawText(hdcColor, digit, 1, &rc, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX);
+            SelectObject(hdcColor, hOldFont);
+            DeleteObject(hFont);
+        }
+
+        SelectObject(hdcColor, hOldColor);
+        SelectObject(hdcMask, hOldMask);
+
+        ICONINFO ii = {};
+        ii.fIcon = TRUE;
+        ii.hbmMask = hMask;
+        ii.hbmColor = hColor;
+        hIcon = CreateIconIndirect(&ii);  // Copies the bitmaps
+    }
+
+    if (hColor) DeleteObject(hColor);
+    if (hMask) DeleteObject(hMask);
+    if (hdcColor) DeleteDC(hdcColor);
+    if (hdcMask) DeleteDC(hdcMask);
+    if (hBase) DestroyIcon(hBase);
+
+    return hIcon;
+}
+
+// Destroy all rendered tray icons
+void ReleaseTrayBadgeCache() {
+    for (int i = 0; i < TRAY_BADGE_CACHE_SIZE; i++) {
+        // Shared icons from LoadIcon must not be destroyed
+        if (g_trayBadgeCache[i] && !g_trayBadgeShared[i]) {
+            DestroyIcon(g_trayBadgeCache[i]);
+        }
+        g_trayBadgeCache[i] = NULL;
+        g_trayBadgeShared[i] = false;
+    }
+}
+
+#ifdef PRIMARY_SELFTEST
+// Self-check for the tray badge cache (build with -DPRIMARY_SELFTEST)
+// State changes that hit the cache must not create GDI or USER objects,
+// rendering every state repeatedly must not leak any, and every state must
+// render. Prints the counts to stdout and returns 0 on success, 1 on failure.
+int RunTrayBadgeSelfTest() {
+    const int STATE_CHANGES = 10000;
+    const int RENDER_ROUNDS = 500;
+    const int STATE_CYCLE = 2 * 2 * (TRAY_BADGE_COUNT_SLOTS + 2);  // Includes counts past the overflow
+    HANDLE hProcess = GetCurrentProcess();
+
+    // One uncounted round first, so one-time system allocations are not counted
+    for (int i = 0; i < STATE_CYCLE; i++) {
+        g_autoSwitchActive = (i / 2) % 2 != 0;
+        g_externalMouseCount = i / 4;
+        GetTrayBadgeIcon((i % 2) ? IDI_ICON_LEFT : IDI_ICON_RIGHT);
+    }
+    ReleaseTrayBadgeCache();
+
+    DWORD gdiStart = GetGuiResources(hProcess, GR_GDIOBJECTS);
+    DWORD userStart = GetGuiResources(hProcess, GR_USEROBJECTS);
+
+    // Rendering: fill every state, release, repeat
+    for (int round = 0; round < RENDER_ROUNDS; round++) {
+        for (int i = 0; i < STATE_CYCLE; i++) {
+            g_autoSwitchActive = (i / 2) % 2 != 0;
+            g_externalMouseCount = i / 4;
+            GetTrayBadgeIcon((i % 2) ? IDI_ICON_LEFT : IDI_ICON_RIGHT);
+        }
+        ReleaseTrayBadgeCache();
+    }
+
+    DWORD gdiAfterRender = GetGuiResources(hProcess, GR_GDIOBJECTS);
+    DWORD userAfterRender = GetGuiResources(hProcess, GR_USEROBJECTS);
+
+    // State changes: warm the cache once, then every change must be a hit
+    for (int i = 0; i < STATE_CYCLE; i++) {
+        g_autoSwitchActive = (i / 2) % 2 != 0;
+        g_externalMouseCount = i / 4;
+        GetTrayBadgeIcon((i % 2) ? IDI_ICON_LEFT : IDI_ICON_RIGHT);
+    }
+
+    int renderFailures = 0;
+    for (int i = 0; i < TRAY_BADGE_CACHE_SIZE; i++) {
+        if (g_trayBadgeShared[i]) {
+            renderFailures++;
+        }
+    }
+
+    DWORD gdiWarm = GetGuiResources(hProcess, GR_GDIOBJECTS);
+    DWORD userWarm = GetGuiResources(hProcess, GR_USEROBJECTS);
+
+    for (int i = 0; i < STATE_CHANGES; i++) {
+        int state = (i * 7) % STATE_CYCLE;  // Step through states out of order
+        g_autoSwitchActive = (state / 2) % 2 != 0;
+        g_externalMouseCount = state / 4;
+        GetTrayBadgeIcon((state % 2) ? IDI_ICON_LEFT : IDI_ICON_RIGHT);
+    }
+
+    DWORD gdiEnd = GetGuiResources(hProcess, GR_GDIOBJECTS);
+    DWORD userEnd = GetGuiResources(hProcess, GR_USEROBJECTS);
+    ReleaseTrayBadgeCache();
+
+    bool passed = renderFailures == 0 &&
+                  gdiAfterRender == gdiStart && userAfterRender == userStart &&
+                  gdiEnd == gdiWarm && userEnd == userWarm;
+
+    char report[256];
+    int length = wsprintfA(report,
+                           "Render rounds: %d  GDI %lu -> %lu  USER %lu -> %lu\r\n"
+                           "State changes: %d  GDI %lu -> %lu  USER %lu -> %lu\r\n"
+                           "Render failures: %d\r\n"
+                           "%s\r\n",
+                           RENDER_ROUNDS, gdiStart, gdiAfterRender, userStart, userAfterRender,
+                           STATE_CHANGES, gdiWarm, gdiEnd, userWarm, userEnd,
+                           renderFailures,
+                           passed ? "PASS" : "FAIL");
+    DWORD written;
+    WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), report, (DWORD)length, &written, NULL);
+
+    return passed ? 0 : 1;
+}
+#endif
+
 // Remove tray icon
 void RemoveTrayIcon(HWND hwnd) {
     Shell_NotifyIcon(NIM_DELETE, &g_nid);
@@ -347,6 +636,10 @@ bool SetStartupEnabled(bool enable) {
 
 // Options dialog procedure
 INT_PTR CALLBACK OptionsDialogProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam) {
+    // Mouse that was in use when the dialog opened (the one being overridden)
+    static HANDLE s_activeDevice = NULL;
+    static bool s_activeDeviceExternal = false;
+
     switch (msg) {
         case WM_INITDIALOG: {
             // Set checkbox states based on current settings
@@ -354,6 +647,18 @@ INT_PTR CALLBACK OptionsDialogProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM
                           IsStartupEnabled() ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwndDlg, IDC_AUTOSWITCH_CHECKBOX,
                           IsAutoSwitchEnabled() ? BST_CHECKED : BST_UNCHECKED);
+            CheckDlgButton(hwndDlg, IDC_FOLLOWACTIVE_CHECKBOX,
+                          IsFollowActiveDeviceEnabled() ? BST_CHECKED : BST_UNCHECKED);
+
+            // Per-device override is only possible for a mouse follow mode has identified
+            s_activeDevice = NULL;
+            if (g_followActiveDevice && g_lastInputDevice != INVALID_HANDLE_VALUE) {
+                s_activeDevice = g_lastInputDevice;
+            }
+            s_activeDeviceExternal = (s_activeDevice != NULL) && IsExternalMouseDevice(s_activeDevice);
+            CheckDlgButton(hwndDlg, IDC_ACTIVE_EXTERNAL_CHECKBOX,
+                          s_activeDeviceExternal ? BST_CHECKED : BST_UNCHECKED);
+            EnableWindow(GetDlgItem(hwndDlg, IDC_ACTIVE_EXTERNAL_CHECKBOX), s_activeDevice != NULL);
 
             // Display current detected mouse device count
             int detectedCount = GetCurrentMouseDeviceCount();
@@ -375,6 +680,8 @@ INT_PTR CALLBACK OptionsDialogProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM
                     // Get checkbox states
                     bool startupEnabled = (IsDlgButtonChecked(hwndDlg, IDC_STARTUP_CHECKBOX) == BST_CHECKED);
                     bool autoSwitchEnabled = (IsDlgButtonChecked(hwndDlg, IDC_AUTOSWITCH_CHECKBOX) == BST_CHECKED);
+                    bool followActiveEnabled = (IsDlgButtonChecked(hwndDlg, IDC_FOLLOWACTIVE_CHECKBOX) == BST_CHECKED);
+                    bool activeDeviceExternal = (IsDlgButtonChecked(hwndDlg, IDC_ACTIVE_EXTERNAL_CHECKBOX) == BST_CHECKED);
 
                     // Get base mouse count from edit control
                     wchar_t countStr[16];
@@ -398,6 +705,24 @@ INT_PTR CALLBACK OptionsDialogProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM
                                   MB_ICONERROR | MB_OK);
                     }
 
+                    // Apply per-device override for the mouse in use
+                    if (s_activeDevice != NULL && activeDeviceExternal != s_activeDeviceExternal) {
+                        if (!SetMouseDeviceOverride(s_activeDevice, activeDeviceExternal)) {
+                            MessageBox(hwndDlg,
+                                      L"Failed to update the mouse override. Please check your permissions.",
+                                      L"Error",
+                                      MB_ICONERROR | MB_OK);
+                        }
+                    }
+
+                    // Apply follow-active-device setting (read by StartAutoSwitchMonitoring below)
+                    if (!SetFollowActiveDeviceEnabled(followActiveEnabled)) {
+                        MessageBox(hwndDlg,
+                                  L"Failed to update follow-active-device setting. Please check your permissions.",
+                                  L"Error",
+                                  MB_ICONERROR | MB_OK);
+                    }
+
                     // Apply auto-switch setting
                     if (!SetAutoSwitchEnabled(autoSwitchEnabled)) {
                         MessageBox(hwndDlg,
@@ -568,24 +893,313 @@ int GetCurrentMouseDeviceCount() {
     return mouseCount;
 }
 
-// Check if an external mouse is connected
-bool IsExternalMouseConnected() {
+// Get the number of external mice (devices above the base count)
+int GetExternalMouseCount() {
     int currentCount = GetCurrentMouseDeviceCount();
     int baseCount = GetBaseMouseCount();
 
+    return (currentCount > baseCount) ? currentCount - baseCount : 0;
+}
+
+// Check if an external mouse is connected
+bool IsExternalMouseConnected() {
     // If current count exceeds base count, we have external mouse(s)
-    return (currentCount > baseCount);
+    return GetExternalMouseCount() > 0;
 }
 
-// Check if external mouse is connected and apply appropriate mouse configuration
-void CheckAndApplyAutoSwitch() {
-    bool externalMouseConnected = IsExternalMouseConnected();
+// Check if follow-active-device mode is enabled (default: false)
+bool IsFollowActiveDeviceEnabled() {
+    HKEY hKey;
+    bool enabled = false;  // Default to disabled if setting doesn't exist
+
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, SETTINGS_REGISTRY_KEY, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+        DWORD value = 0;
+        DWORD size = sizeof(value);
+        DWORD type;
 
+        if (RegQueryValueEx(hKey, FOLLOW_ACTIVE_VALUE, NULL, &type, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            if (type == REG_DWORD) {
+                enabled = (value != 0);
+            }
+        }
+
+        RegCloseKey(hKey);
+    }
+
+    return enabled;
+}
+
+// Enable or disable follow-active-device mode
+bool SetFollowActiveDeviceEnabled(bool enable) {
+    HKEY hKey;
+    bool success = false;
+    DWORD disposition;
+
+    // Create or open the settings key
+    if (RegCreateKeyEx(HKEY_CURRENT_USER, SETTINGS_REGISTRY_KEY, 0, NULL, 0,
+                       KEY_WRITE, NULL, &hKey, &disposition) == ERROR_SUCCESS) {
+        DWORD value = enable ? 1 : 0;
+        if (RegSetValueEx(hKey, FOLLOW_ACTIVE_VALUE, 0, REG_DWORD, (LPBYTE)&value, sizeof(value)) == ERROR_SUCCESS) {
+            success = true;
+        }
+
+        RegCloseKey(hKey);
+    }
+
+    return success;
+}
+
+// Get the device interface name of a raw input mouse
+bool GetMouseDeviceName(HANDLE hDevice, wchar_t* name, UINT size) {
+    UINT length = size;  // In characters; only updated by the call on failure
+    if (GetRawInputDeviceInfo(hDevice, RIDI_DEVICENAME, name, &length) == (UINT)-1) {
+        return false;
+    }
+
+    name[size - 1] = L'\0';
+    CharUpperBuff(name, (DWORD)wcslen(name));
+    return true;
+}
+
+// Get the user's override for a mouse: 1 external, 0 built-in, -1 none
+int GetMouseDeviceOverride(const wchar_t* name) {
+    HKEY hKey;
+    int result = -1;
+
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, DEVICE_OVERRIDES_REGISTRY_KEY, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+        DWORD value = 0;
+        DWORD size = sizeof(value);
+        DWORD type;
+
+        if (RegQueryValueEx(hKey, name, NULL, &type, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            if (type == REG_DWORD) {
+                result = (value != 0) ? 1 : 0;
+            }
+        }
+
+        RegCloseKey(hKey);
+    }
+
+    return result;
+}
+
+// Store an override for a mouse, keyed by its device interface name
+bool SetMouseDeviceOverride(HANDLE hDevice, bool isExternal) {
+    wchar_t name[MAX_PATH];
+    if (!GetMouseDeviceName(hDevice, name, MAX_PATH)) {
+        return false;
+    }
+
+    HKEY hKey;
+    bool success = false;
+    DWORD disposition;
+
+    // Create or open the overrides key
+    if (RegCreateKeyEx(HKEY_CURRENT_USER, DEVICE_OVERRIDES_REGISTRY_KEY, 0, NULL, 0,
+                       KEY_WRITE, NULL, &hKey, &disposition) == ERROR_SUCCESS) {
+        DWORD value = isExternal ? 1 : 0;
+        if (RegSetValueEx(hKey, name, 0, REG_DWORD, (LPBYTE)&value, sizeof(value)) == ERROR_SUCCESS) {
+            success = true;
+        }
+
+        RegCloseKey(hKey);
+    }
+
+    if (success) {
+        // Reclassify now, and re-apply on the next sampled packet
+        ForgetMouseDevice(hDevice);
+        AddMouseDevice(hDevice);
+        UpdateFollowedMouseCount();
+    }
+
+    return success;
+}
+
+// Classify a raw input mouse as external or built-in, from its name and the user's overrides
+bool ClassifyMouseDevice(HANDLE hDevice) {
+    wchar_t name[MAX_PATH];
+    if (!GetMouseDeviceName(hDevice, name, MAX_PATH)) {
+        return false;
+    }
+
+    int overrideValue = GetMouseDeviceOverride(name);
+    if (overrideValue >= 0) {
+        return overrideValue == 1;
+    }
+
+    // Built-in trackpads usually sit on I2C/ACPI/PS2; external mice enumerate
+    // over USB (VID_) or Bluetooth (HID and HID-over-GATT service GUIDs).
+    return wcsstr(name, L"VID_") != NULL ||
+           wcsstr(name, L"{00001124-") != NULL ||
+           wcsstr(name, L"{00001812-") != NULL;
+}
+
+// Add a mouse to the device table, classifying it if it is new
+// Returns whether it is external. The device name is read once per device; hDevice must not be NULL.
+bool AddMouseDevice(HANDLE hDevice) {
+    int freeIndex = -1;
+    for (int i = 0; i < DEVICE_CLASS_CACHE_SIZE; i++) {
+        if (g_deviceClassCache[i].hDevice == hDevice) {
+            return g_deviceClassCache[i].isExternal;
+        }
+        if (freeIndex < 0 && g_deviceClassCache[i].hDevice == NULL) {
+            freeIndex = i;
+        }
+    }
+
+    bool isExternal = ClassifyMouseDevice(hDevice);
+
+    // Only slots freed by removal are reused: the table also backs the badge
+    // count, so a connected device is never evicted. When full, go uncached.
+    if (freeIndex >= 0) {
+        g_deviceClassCache[freeIndex].hDevice = hDevice;
+        g_deviceClassCache[freeIndex].isExternal = isExternal;
+    }
+
+    return isExternal;
+}
+
+// Check if a raw input mouse is external
+bool IsExternalMouseDevice(HANDLE hDevice) {
+    // No device handle: precision touchpads on some systems, but also injected
+    // input (remote desktop, mouse jigglers). Treated as built-in.
+    if (hDevice == NULL) {
+        return false;
+    }
+
+    return AddMouseDevice(hDevice);
+}
+
+// Drop a device from the classification cache
+void ForgetMouseDevice(HANDLE hDevice) {
+    for (int i = 0; i < DEVICE_CLASS_CACHE_SIZE; i++) {
+        if (g_deviceClassCache[i].hDevice == hDevice) {
+            g_deviceClassCache[i].hDevice = NULL;
+            g_deviceClassCache[i].isExternal = false;
+        }
+    }
+
+    if (g_lastInputDevice == hDevice) {
+        g_lastInputDevice = INVALID_HANDLE_VALUE;
+    }
+}
+
+// Count external mice in the device table
+int CountExternalMouseDevices() {
+    int count = 0;
+    for (int i = 0; i < DEVICE_CLASS_CACHE_SIZE; i++) {
+        if (g_deviceClassCache[i].hDevice != NULL && g_deviceClassCache[i].isExternal) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Refresh the badge count in follow-active-device mode, without enumerating devices
+void UpdateFollowedMouseCount() {
+    if (!g_followActiveDevice) {
+        return;
+    }
+
+    int count = CountExternalMouseDevices();
+    if (count != g_externalMouseCount) {
+        g_externalMouseCount = count;
+        if (g_hwndMain) {
+            UpdateTrayIcon(g_hwndMain, GetIconForCurrentState());
+        }
+    }
+}
+
+// Switch background raw mouse input on or off, keeping device notifications
+// While off, the window only gets mouse input when it is foreground, which the
+// hidden window is not, so a fast mouse generates no messages for this process.
+bool SetRawMouseSampling(HWND hwnd, bool sampling) {
+    RAWINPUTDEVICE rid = {};
+    rid.usUsagePage = 0x01;  // Generic desktop controls
+    rid.usUsage = 0x02;      // Mouse
+    rid.dwFlags = RIDEV_DEVNOTIFY | (sampling ? RIDEV_INPUTSINK : 0);
+    rid.hwndTarget = hwnd;
+
+    // When pausing, drop packets still queued even if re-registration fails
+    if (!sampling) {
+        g_rawInputSampling = false;
+    }
+
+    if (RegisterRawInputDevices(&rid, 1, sizeof(rid)) == FALSE) {
+        return false;
+    }
+
+    g_rawInputRegistered = true;
+    g_rawInputSampling = sampling;
+    return true;
+}
+
+// Register for background raw mouse input and device arrival/removal notifications
+bool RegisterRawMouseInput(HWND hwnd) {
+    g_lastInputDevice = INVALID_HANDLE_VALUE;
+    return SetRawMouseSampling(hwnd, true);
+}
+
+// Stop receiving raw mouse input
+void UnregisterRawMouseInput(HWND hwnd) {
+    KillTimer(hwnd, TIMER_RAWINPUT_RESUME);
+    g_rawInputSampling = false;
+
+    if (!g_rawInputRegistered) {
+        return;
+    }
+
+    RAWINPUTDEVICE rid = {};
+    rid.usUsagePage = 0x01;
+    rid.usUsage = 0x02;
+    rid.dwFlags = RIDEV_REMOVE;
+    rid.hwndTarget = NULL;
+
+    RegisterRawInputDevices(&rid, 1, sizeof(rid));
+    g_rawInputRegistered = false;
+
+    // A new registration reports every present device as an arrival again
+    for (int i = 0; i < DEVICE_CLASS_CACHE_SIZE; i++) {
+        g_deviceClassCache[i].hDevice = NULL;
+        g_deviceClassCache[i].isExternal = false;
+    }
+}
+
+// Handle a WM_INPUT packet in follow-active-device mode
+// A 1000 Hz mouse would deliver a packet every millisecond. Instead, the first
+// packet pauses background input for RAW_INPUT_PAUSE_MS, so per pause this
+// process sees one sampled packet plus whatever was already queued, which is
+// dropped on the flag check. Only the sampled packet's header is read, and
+// classification runs only when the source device changes.
+void HandleRawMouseInput(HWND hwnd, HRAWINPUT hRawInput) {
+    if (!g_followActiveDevice || !g_rawInputSampling) {
+        return;
+    }
+
+    SetRawMouseSampling(hwnd, false);
+    SetTimer(hwnd, TIMER_RAWINPUT_RESUME, RAW_INPUT_PAUSE_MS, NULL);
+
+    RAWINPUTHEADER header;
+    UINT size = sizeof(header);
+    if (GetRawInputData(hRawInput, RID_HEADER, &header, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) {
+        return;
+    }
+
+    if (header.dwType != RIM_TYPEMOUSE || header.hDevice == g_lastInputDevice) {
+        return;  // Same device as last sample
+    }
+
+    g_lastInputDevice = header.hDevice;
+    ApplyAutoSwitchState(IsExternalMouseDevice(header.hDevice));
+}
+
+// Apply mouse configuration for the given external mouse state
+void ApplyAutoSwitchState(bool externalMouseActive) {
     // Only switch if the state has changed to avoid unnecessary operations
-    if (externalMouseConnected != g_lastDisplayState) {
-        g_lastDisplayState = externalMouseConnected;
+    if (externalMouseActive != g_lastDisplayState) {
+        g_lastDisplayState = externalMouseActive;
 
-        if (externalMouseConnected) {
+        if (externalMouseActive) {
             // External mouse connected → Left-handed
             SwapMouseButton(TRUE);
         } else {
@@ -600,14 +1214,60 @@ void CheckAndApplyAutoSwitch() {
     }
 }
 
+// Check if external mouse is connected and apply appropriate mouse configuration
+void CheckAndApplyAutoSwitch() {
+    // In follow-active-device mode, mere presence of a device must not switch
+    if (g_followActiveDevice) {
+        return;
+    }
+
+    int externalCount = GetExternalMouseCount();
+    bool externalMouseConnected = (externalCount > 0);
+    bool countChanged = (externalCount != g_externalMouseCount);
+    g_externalMouseCount = externalCount;
+
+    if (externalMouseConnected != g_lastDisplayState) {
+        ApplyAutoSwitchState(externalMouseConnected);
+    } else if (countChanged && g_hwndMain) {
+        // Orientation unchanged, but the badge count is stale
+        UpdateTrayIcon(g_hwndMain, GetIconForCurrentState());
+    }
+}
+
 // Start auto-switch monitoring
 // Note: g_lastDisplayState should be initialized by caller before calling this
 void StartAutoSwitchMonitoring(HWND hwnd) {
+    g_followActiveDevice = IsFollowActiveDeviceEnabled();
+    g_autoSwitchActive = true;
+
+    if (g_followActiveDevice) {
+        KillTimer(hwnd, TIMER_AUTOSWITCH);
+        if (RegisterRawMouseInput(hwnd)) {
+            // Start from the actual orientation; the first device used decides
+            g_lastDisplayState = GetCurrentMouseState();
+            // Device arrival notifications fill in the badge count
+            g_externalMouseCount = CountExternalMouseDevices();
+            UpdateTrayIcon(hwnd, GetIconForCurrentState());
+            return;
+        }
+        // Raw input unavailable: fall back to polling for connected devices
+        g_followActiveDevice = false;
+    }
+
+    UnregisterRawMouseInput(hwnd);
     // Set timer to check every 2 seconds
     SetTimer(hwnd, TIMER_AUTOSWITCH, 2000, NULL);
+    UpdateTrayIcon(hwnd, GetIconForCurrentState());
 }
 
 // Stop auto-switch monitoring
 void StopAutoSwitchMonitoring(HWND hwnd) {
     KillTimer(hwnd, TIMER_AUTOSWITCH);
+    UnregisterRawMouseInput(hwnd);
+    g_followActiveDevice = false;
+
+    if (g_autoSwitchActive) {
+        g_autoSwitchActive = false;
+        UpdateTrayIcon(hwnd, GetIconForCurrentState());
+    }
 }
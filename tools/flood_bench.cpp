@@ -0,0 +1,108 @@
+#ifndef UNICODE
+#define UNICODE
+#endif
+
+// Raw input flood benchmark for follow-active-device mode
+//
+// Injects relative mouse moves at a gaming-mouse rate while Primary is running
+// and reports the CPU time Primary spent during the run. Enable "Follow the
+// mouse in use" in Primary's options first.
+//
+// Injected input carries no device handle, so Primary classes it as built-in
+// and switches to right-handed while the benchmark runs. The button setting
+// from before the run is restored afterwards.
+//
+// Passes (exit code 0) if Primary stays under MAX_LOAD_PERCENT of one core.
+//
+// Usage: FloodBench.exe [packets] [rate_hz]   (defaults: 10000 1000)
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../resources/app_strings.h"
+
+// Bound for Primary's CPU use during the flood, in percent of one core
+const double MAX_LOAD_PERCENT = 1.0;
+
+// Total user + kernel CPU time of a process, in microseconds
+double GetProcessCpuMicroseconds(HANDLE hProcess) {
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(hProcess, &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) / 10.0;  // 100 ns units
+}
+
+int wmain(int argc, wchar_t** argv) {
+    int packets = (argc > 1) ? _wtoi(argv[1]) : 10000;
+    int rate = (argc > 2) ? _wtoi(argv[2]) : 1000;
+    if (packets < 1 || rate < 1) {
+        fwprintf(stderr, L"Usage: FloodBench.exe [packets] [rate_hz]\n");
+        return 2;
+    }
+
+    HWND hwnd = FindWindow(APP_WINDOW_CLASS, NULL);
+    if (hwnd == NULL) {
+        fwprintf(stderr, L"%s is not running.\n", APP_NAME);
+        return 1;
+    }
+
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (hProcess == NULL) {
+        fwprintf(stderr, L"Cannot open %s process (error %lu).\n", APP_NAME, GetLastError());
+        return 1;
+    }
+
+    LARGE_INTEGER freq, start, now;
+    QueryPerformanceFrequency(&freq);
+
+    INPUT input = {};
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = MOUSEEVENTF_MOVE;
+
+    bool swappedBefore = GetSystemMetrics(SM_SWAPBUTTON) != 0;
+    double cpuBefore = GetProcessCpuMicroseconds(hProcess);
+    QueryPerformanceCounter(&start);
+
+    for (int i = 0; i < packets; i++) {
+        // Pace packets evenly at the requested rate
+        LONGLONG due = start.QuadPart + freq.QuadPart * i / rate;
+        do {
+            QueryPerformanceCounter(&now);
+        } while (now.QuadPart < due);
+
+        input.mi.dx = (i & 1) ? 1 : -1;  // Jitter in place so the cursor does not drift
+        SendInput(1, &input, sizeof(INPUT));
+    }
+
+    QueryPerformanceCounter(&now);
+    double seconds = (double)(now.QuadPart - start.QuadPart) / freq.QuadPart;
+
+    // Let Primary drain its queue before taking the second reading
+    Sleep(500);
+    double cpuMicroseconds = GetProcessCpuMicroseconds(hProcess) - cpuBefore;
+    CloseHandle(hProcess);
+
+    // Undo the switch to right-handed caused by the injected input
+    SwapMouseButton(swappedBefore ? TRUE : FALSE);
+
+    double loadPercent = cpuMicroseconds / (seconds * 1e6) * 100.0;
+    bool passed = loadPercent < MAX_LOAD_PERCENT;
+
+    wprintf(L"Packets:      %d at %d Hz over %.2f s\n", packets, rate, seconds);
+    wprintf(L"%s CPU:  %.1f ms total\n", APP_NAME, cpuMicroseconds / 1000.0);
+    wprintf(L"Per packet:   %.3f us\n", cpuMicroseconds / packets);
+    wprintf(L"Load:         %.3f%% of one core\n", loadPercent);
+    wprintf(L"%s: load %s %.1f%% of one core\n",
+            passed ? L"PASS" : L"FAIL", passed ? L"below" : L"at or above", MAX_LOAD_PERCENT);
+
+    return passed ? 0 : 1;
+}